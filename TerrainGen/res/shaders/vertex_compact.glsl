@@ -0,0 +1,47 @@
+#version 330 core
+// vertex.glsl for the compact vertex layout: a 16-bit height, an octahedral normal and an RGBA8 colour
+// x and z follow from the vertex index, the same grid the CPU lays out
+layout(location = 0) in float aHeight;
+layout(location = 1) in ivec2 aNormal;
+layout(location = 2) in vec4 aColor;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform int vertexCount;
+uniform float vertexSize;
+// aHeight is 0..1 over heightMin..heightMin + heightRange
+uniform float heightMin;
+uniform float heightRange;
+
+out vec3 FragPos;
+out vec3 Normal;
+
+flat out vec3 Color;
+
+// encodeNormal in CompactVertex.h backwards
+vec3 decodeNormal(ivec2 encoded)
+{
+	vec2 e = vec2(encoded) / 32767.0;
+	vec3 n = vec3(e.x, 1.0 - abs(e.x) - abs(e.y), e.y);
+	if (n.y < 0.0)
+	{
+		vec2 signs = vec2(n.x >= 0.0 ? 1.0 : -1.0, n.z >= 0.0 ? 1.0 : -1.0);
+		n.xz = (1.0 - abs(n.zx)) * signs;
+	}
+	return normalize(n);
+}
+
+void main()
+{
+	int col = gl_VertexID % vertexCount;
+	int row = gl_VertexID / vertexCount;
+	vec3 pos = vec3(float(col) / (float(vertexCount) - 1.0) * vertexSize,
+		heightMin + aHeight * heightRange,
+		float(row) / (float(vertexCount) - 1.0) * vertexSize);
+
+	Normal = decodeNormal(aNormal);
+	Color = aColor.rgb;
+	FragPos = pos;
+	gl_Position = projection * view * vec4(pos, 1.0);
+}
@@ -0,0 +1,66 @@
+#version 330 core
+// vertex.glsl for the height texture mode: one static grid and no vertex attributes
+// x and z follow from the vertex index, the height from heightMap, the normal and colour from the heights
+// HeightTexture::MAX_BIOMES on the C++ side, keep the two in step
+const int MAX_BIOMES = 8;
+
+uniform mat4 view;
+uniform mat4 projection;
+
+uniform int vertexCount;
+uniform float vertexSize;
+// position of the first vertex, another chunk is the same grid with its own heightMap and origin
+uniform vec2 gridOrigin;
+
+// the heights with heightApron texels around them, see HeightTexture.h
+uniform sampler2D heightMap;
+uniform int heightApron;
+
+// the biome colours and spread of ColourGenerator, and the amplitude of the current heights
+uniform vec3 biomeColours[MAX_BIOMES];
+uniform int biomeCount;
+uniform float colourSpread;
+uniform float amplitude;
+
+out vec3 FragPos;
+out vec3 Normal;
+
+flat out vec3 Color;
+
+// without an apron the edge heights are repeated outwards, as in NormalGenerator
+float height(ivec2 vertex)
+{
+	ivec2 texel = clamp(vertex + heightApron, ivec2(0), textureSize(heightMap, 0) - 1);
+	return texelFetch(heightMap, texel, 0).r;
+}
+
+// ColourGenerator::calculateColour
+vec3 biomeColour(float h)
+{
+	float value = (h + amplitude) / (amplitude * 2.0);
+	value = clamp((value - colourSpread * 0.5) / colourSpread, 0.0, 0.9999);
+
+	float part = 1.0 / float(biomeCount - 1);
+	int firstBiome = int(floor(value / part));
+	float blend = (value - float(firstBiome) * part) / part;
+	return mix(biomeColours[firstBiome], biomeColours[firstBiome + 1], blend);
+}
+
+void main()
+{
+	ivec2 vertex = ivec2(gl_VertexID % vertexCount, gl_VertexID / vertexCount);
+	float h = height(vertex);
+	vec3 pos = vec3(gridOrigin.x + float(vertex.x) / (float(vertexCount) - 1.0) * vertexSize,
+		h,
+		gridOrigin.y + float(vertex.y) / (float(vertexCount) - 1.0) * vertexSize);
+
+	float heightL = height(vertex - ivec2(1, 0));
+	float heightR = height(vertex + ivec2(1, 0));
+	float heightD = height(vertex - ivec2(0, 1));
+	float heightU = height(vertex + ivec2(0, 1));
+
+	Normal = normalize(vec3(heightL - heightR, 2.0, heightD - heightU));
+	Color = biomeColour(h);
+	FragPos = pos;
+	gl_Position = projection * view * vec4(pos, 1.0);
+}
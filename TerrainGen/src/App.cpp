@@ -9,9 +9,22 @@
 #include "Color.h"
 #include "NormalGenerator.h"
 #include "IndexGenerator.h"
+#include "HeightGenerator.h"
+#include "Heightfield.h"
+#include "HeightStats.h"
+#include "HeightTexture.h"
+#include "NoiseConfig.h"
+#include "TerrainVertices.h"
+#include "ThreadPool.h"
+#include "TileCache.h"
+#include "VertexLayoutBenchmark.h"
 
 #include "vendor/noise/FastNoise.h"
+#include "vendor/noise/FastNoiseStatic.h"
+#include "vendor/noise/FastNoiseVolume.h"
 
+#include <algorithm>
+#include <cassert>
 #include <ctime>
 #include <iostream>
 
@@ -38,6 +51,66 @@ bool flag = false;
 constexpr unsigned int VERTEX_COUNT = 200;
 constexpr float VERTEX_SIZE = 10.0f;
 
+// threads used to generate the heights, 0 = one per hardware thread
+constexpr unsigned GENERATION_THREADS = 0;
+
+// prints diagnostics to the console: the height stats of the first terrain, the hierarchical heights error
+// and the tile cache counters at exit
+constexpr bool PRINT_DIAGNOSTICS = false;
+
+// normals from the noise gradient while generating heights, false = finite differences of the heights
+constexpr bool ANALYTIC_NORMALS = true;
+
+// samples generated around the heights from the same noise, for the finite difference normals
+// the edge vertices see their real neighbours, chunks side by side get matching edge normals. 0 = clamp at the edge
+constexpr int HEIGHT_APRON = 1;
+
+// skip the fractal octaves that are finer than the vertex spacing, they only add aliasing
+constexpr bool OCTAVE_CUTOFF = true;
+
+// domain warp: every vertex samples the terrain noise at a position moved by a fractal GradientPerturb
+// the warped gradient isn't the noise gradient, so warped terrain always uses finite difference normals
+constexpr bool DOMAIN_WARP = false;
+constexpr float WARP_AMPLITUDE = 30.0f;
+constexpr float WARP_FREQUENCY = 0.01f;
+
+// hierarchical heights: the octaves below HIERARCHICAL_SPLIT_FREQUENCY are only evaluated on every
+// HIERARCHICAL_COARSE_STEP-th vertex and upsampled bicubically, the rest at every vertex
+// approximate, PRINT_DIAGNOSTICS prints the error against full evaluation. Uses finite difference normals
+constexpr bool HIERARCHICAL = false;
+constexpr float HIERARCHICAL_SPLIT_FREQUENCY = 0.1f;
+constexpr int HIERARCHICAL_COARSE_STEP = 4;
+
+// animated terrain: the heights are a z slice of 3D noise and z moves this many units per second, 0 = static
+// consecutive slices share most of their work through FastNoiseVolume
+constexpr float ANIMATION_SPEED = 0.0f;
+
+// tileable terrain: the heights wrap around on both axes, copies of the mesh can be laid side by side
+// sampled from 4D noise on a torus, which exists for the Value and Simplex noise types and their fractals
+constexpr bool TILEABLE = false;
+
+// the chunk of a large world the mesh shows, chunks are VERTEX_COUNT - 1 units wide
+// the noise splits the chunk origin off exactly, chunks millions of units out stay as smooth as chunk 0
+constexpr int WORLD_CHUNK_X = 0;
+constexpr int WORLD_CHUNK_Z = 0;
+constexpr bool WORLD_CHUNK = WORLD_CHUNK_X != 0 || WORLD_CHUNK_Z != 0;
+
+// generated heights (and analytic normals) kept in memory, keyed by the seed and the noise settings
+// going back to a seed seen before copies the tile instead of generating it, 0 = no cache
+constexpr size_t TILE_CACHE_BYTES = 64 * 1024 * 1024;
+
+// position, normal and colour of a vertex next to each other in one VBO, false = one VBO per attribute
+constexpr bool INTERLEAVED_VERTICES = false;
+// times the upload and drawing of both vertex layouts at startup, over this many repeats, 0 = off
+constexpr int LAYOUT_BENCHMARK_REPEATS = 0;
+// 10 bytes per vertex instead of 36: a 16-bit height, an octahedral normal and an RGBA8 colour,
+// vertex_compact.glsl derives x and z from the vertex index. Overrides INTERLEAVED_VERTICES
+constexpr bool COMPACT_VERTICES = false;
+// the heights in a texture and one static grid mesh without vertex data, vertex_heightmap.glsl displaces it
+// and derives the normals and colours, a new terrain is a single texture upload
+constexpr bool HEIGHT_TEXTURE = false;
+static_assert(!(HEIGHT_TEXTURE && COMPACT_VERTICES), "the height texture mode has no vertex data to compact");
+
 
 //Color generation settings
 constexpr float COLOUR_SPREAD = 0.45f; 
@@ -55,6 +128,12 @@ constexpr FastNoise::Interp	     INTERP = FastNoise::Interp::Linear;
 constexpr FastNoise::FractalType TYPE = FastNoise::FractalType::FBM;
 constexpr float					 LACUNARITY = 2.5f;
 constexpr float					 GAIN = 0.5f;
+// IntegerHash: arithmetic lattice hash instead of the seeded permutation table, a different but
+// equally random terrain per seed, reseeding is free and the SIMD value noise needs no gathers
+constexpr FastNoise::HashType	 HASH = FastNoise::HashType::PermutationTable;
+
+// the settings above are fixed at compile time, StaticNoise bakes them into the generator
+using TerrainNoise = StaticNoise<NOISE_TYPE, TYPE, INTERP, FRACTAL_OCTAVES, HASH>;
 
 int main()
 {
@@ -92,43 +171,247 @@ int main()
 		return -1;
 	}
 
-	Shader ourShader("TerrainGen/res/shaders/vertex.glsl", "TerrainGen/res/shaders/fragment.glsl");
+	Shader ourShader(HEIGHT_TEXTURE ? "TerrainGen/res/shaders/vertex_heightmap.glsl" :
+		COMPACT_VERTICES ? "TerrainGen/res/shaders/vertex_compact.glsl" : "TerrainGen/res/shaders/vertex.glsl",
+		"TerrainGen/res/shaders/fragment.glsl");
 	NormalGenerator normalGenerator(VERTEX_COUNT);
 	ColourGenerator colorGen(TERRAIN_COLS, COLOUR_SPREAD, VERTEX_COUNT);
 	IndexGenerator indexGenerator;
-	FastNoise noiseGenerator(std::rand());
-	noiseGenerator.SetNoiseType(NOISE_TYPE);
-	noiseGenerator.SetFrequency(FREQUENCY);
-	noiseGenerator.SetFractalOctaves(FRACTAL_OCTAVES);
-	noiseGenerator.SetInterp(INTERP);
-	noiseGenerator.SetFractalType(TYPE);
-	noiseGenerator.SetFractalLacunarity(LACUNARITY);
-	noiseGenerator.SetFractalGain(GAIN);
+	ThreadPool threadPool(GENERATION_THREADS);
+	HeightGenerator heightGenerator(VERTEX_COUNT, threadPool);
+	// one seed describes the whole terrain, the generators derive theirs from it
+	int seed = std::rand();
+	FastNoise warpGenerator(seed + 1);
+	warpGenerator.SetGradientPerturbAmp(WARP_AMPLITUDE);
+	warpGenerator.SetFrequency(WARP_FREQUENCY);
+	// the terrain noise settings, edited by the input code, generation only reads published snapshots of them
+	FastNoise runtimeGenerator(seed);
+	runtimeGenerator.SetHashType(HASH);
+	runtimeGenerator.SetNoiseType(NOISE_TYPE);
+	runtimeGenerator.SetInterp(INTERP);
+	runtimeGenerator.SetFractalType(TYPE);
+	runtimeGenerator.SetFractalOctaves(FRACTAL_OCTAVES);
+	runtimeGenerator.SetFrequency(FREQUENCY);
+	runtimeGenerator.SetFractalLacunarity(LACUNARITY);
+	runtimeGenerator.SetFractalGain(GAIN);
+	if (OCTAVE_CUTOFF)
+		runtimeGenerator.SetFractalSampleSpacing(1.0f); // HeightGenerator samples at integer coordinates
+	// generation samples a published snapshot of runtimeGenerator and warpGenerator, never the objects the input code edits
+	NoiseConfigPublisher runtimeConfigs(runtimeGenerator, warpGenerator);
+
+	// the StaticNoise of a snapshot, for the modes it covers: the compile time settings are the constants
+	// runtimeGenerator was set up with, the seed and the runtime settings come from the snapshot
+	auto terrainNoiseOf = [](const FastNoise& noise)
+	{
+		TerrainNoise terrainNoise(noise.GetSeed());
+		terrainNoise.SetFrequency(noise.GetFrequency());
+		terrainNoise.SetFractalLacunarity(noise.GetFractalLacunarity());
+		terrainNoise.SetFractalGain(noise.GetFractalGain());
+		terrainNoise.SetFractalSampleSpacing(noise.GetFractalSampleSpacing());
+		return terrainNoise;
+	};
+
+	// the animated terrain's volume and the snapshot it samples, rebuilt when a newer snapshot is published
+	std::shared_ptr<const NoiseConfig> animatedConfig;
+	std::unique_ptr<FastNoiseVolume> animatedVolume;
+
+	if (HIERARCHICAL && PRINT_DIAGNOSTICS)
+	{
+		FastNoise::HierarchicalError error = runtimeGenerator.MeasureHierarchicalError(VERTEX_COUNT, VERTEX_COUNT,
+			0.0f, 0.0f, 1.0f, HIERARCHICAL_SPLIT_FREQUENCY, HIERARCHICAL_COARSE_STEP);
+		std::cout << "hierarchical heights: " << error.coarseOctaves << " of " << runtimeGenerator.GetFractalActiveOctaves()
+			<< " octaves coarse, max error " << error.maxError << ", rms error " << error.rmsError << std::endl;
+	}
 
 
 	//allocationg memory
 	int count = VERTEX_COUNT * VERTEX_COUNT;
-	float* vertices = new float[count * 3];
-	float* normals = new float[count * 3];
-	float* colors = new float[count * 3];
-
-	float** heights = new float* [VERTEX_COUNT];
-	for (int i = 0; i < VERTEX_COUNT; i++)
-		heights[i] = new float[VERTEX_COUNT];
+	// the generators write every attribute straight into mesh, vertexStride floats from one vertex to the next
+	// the compact layout has compactHeights and one CompactAttributes per vertex instead, the height texture mode nothing
+	TerrainVertices mesh(HEIGHT_TEXTURE ? 0 : count, COMPACT_VERTICES ? TerrainVertices::Compact : INTERLEAVED_VERTICES ? TerrainVertices::Interleaved : TerrainVertices::Separate);
+	float* vertices = mesh.positions();
+	float* normals = mesh.normals();
+	float* colors = mesh.colors();
+	const int vertexStride = mesh.getStride();
+	uint16_t* compactHeights = mesh.heights();
+	CompactAttributes* compactAttributes = mesh.attributes();
+	// the range the compact heights are quantized to, the height stats of the current terrain
+	HeightQuantizer heightQuantizer(-1.0f, 1.0f);
+	float* noiseValues = new float[count];
+
+	Heightfield heights(VERTEX_COUNT, VERTEX_COUNT, HEIGHT_APRON);
+	HeightTexture heightTexture(VERTEX_COUNT, VERTEX_COUNT, HEIGHT_APRON);
 
 	unsigned int* indices = new unsigned int[6 * (VERTEX_COUNT - 1) * (VERTEX_COUNT - 1)];
 
+	// the height texture mode computes its normals in the shader, from the heights and their apron
+	const bool analyticNormals = ANALYTIC_NORMALS && !HEIGHT_TEXTURE;
+
+	// what a cached tile holds depends on the generation mode
+	enum TileMode { PlainTile, NormalsTile, WarpedTile, TileableTile, ChunkTile, HierarchicalTile };
+	const TileMode tileMode = TILEABLE ? TileableTile : WORLD_CHUNK ? ChunkTile : DOMAIN_WARP ? WarpedTile : HIERARCHICAL ? HierarchicalTile : analyticNormals ? NormalsTile : PlainTile;
+	const bool tileHasNormals = tileMode == NormalsTile;
+	TileCache tileCache(TILE_CACHE_BYTES);
+
+	// min, max, mean and histogram of noiseValues, collected by the generation and cached with the tile
+	HeightStats heightStats;
+
+	// a tile holds the heights, the normals if the mode has them, then the height stats
+	// tile normals are 3 floats per vertex, or the 2 octahedral components with compact vertices
+	auto loadTileNormals = [&](const float* tileNormals)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (COMPACT_VERTICES)
+			{
+				compactAttributes[i].normal[0] = static_cast<int16_t>(tileNormals[i * 2 + 0]);
+				compactAttributes[i].normal[1] = static_cast<int16_t>(tileNormals[i * 2 + 1]);
+			}
+			else
+				std::copy(tileNormals + i * 3, tileNormals + i * 3 + 3, normals + i * vertexStride);
+		}
+	};
+	auto storeTileNormals = [&](std::vector<float>& tile)
+	{
+		for (int i = 0; i < count; i++)
+		{
+			if (COMPACT_VERTICES)
+				tile.insert(tile.end(), compactAttributes[i].normal, compactAttributes[i].normal + 2);
+			else
+				tile.insert(tile.end(), normals + i * vertexStride, normals + i * vertexStride + 3);
+		}
+	};
+
+	// heights of the snapshot config into noiseValues, and the normals when they come from the noise gradient
+	// everything is sampled from config, the tile key describes exactly the noise that made the tile
+	// the warp settings follow from the seed and the constants
+	auto generateNoise = [&](const NoiseConfig& config)
+	{
+		const FastNoise& runtimeNoise = config.getNoise();
+
+		// chunk tiles are keyed by the chunk index, exact in a float up to 2^24
+		TileKey key(runtimeNoise, static_cast<float>(WORLD_CHUNK_X), static_cast<float>(WORLD_CHUNK_Z), 1.0f, VERTEX_COUNT, VERTEX_COUNT, tileMode);
+		if (const std::vector<float>* tile = tileCache.find(key))
+		{
+			std::copy(tile->begin(), tile->begin() + count, noiseValues);
+			if (tileHasNormals)
+				loadTileNormals(tile->data() + count);
+			heightStats.read(tile->data() + tile->size() - heightStats.floatCount());
+			return;
+		}
+
+		TerrainNoise terrainNoise = terrainNoiseOf(runtimeNoise);
+
+		if (TILEABLE)
+			heightGenerator.generateTile(runtimeNoise, noiseValues, &heightStats);
+		else if (WORLD_CHUNK)
+			heightGenerator.generateChunk(runtimeNoise, WORLD_CHUNK_X, WORLD_CHUNK_Z, noiseValues, &heightStats);
+		else if (DOMAIN_WARP)
+			heightGenerator.generateWarpedHeights(terrainNoise, config.getWarp(), noiseValues, &heightStats);
+		else if (HIERARCHICAL)
+			heightGenerator.generateHierarchicalHeights(runtimeNoise, HIERARCHICAL_SPLIT_FREQUENCY, HIERARCHICAL_COARSE_STEP, noiseValues, &heightStats);
+		else if (analyticNormals && COMPACT_VERTICES)
+			heightGenerator.generateHeightsAndNormals(terrainNoise, normalGenerator, noiseValues, compactAttributes, &heightStats);
+		else if (analyticNormals)
+			heightGenerator.generateHeightsAndNormals(terrainNoise, normalGenerator, noiseValues, normals, &heightStats, vertexStride);
+		else
+			heightGenerator.generateHeights(terrainNoise, noiseValues, &heightStats);
+
+		if (TILE_CACHE_BYTES > 0)
+		{
+			std::vector<float> tile(noiseValues, noiseValues + count);
+			if (tileHasNormals)
+				storeTileNormals(tile);
+			tile.resize(tile.size() + heightStats.floatCount());
+			heightStats.write(tile.data() + tile.size() - heightStats.floatCount());
+			tileCache.insert(key, std::move(tile));
+		}
+	};
+
+
+
+	// the apron of heights, from the function and snapshot the heights of this frame came from, z is the animation slice
+	// hierarchical heights get exact samples around them, the approximation only matters inside
+	auto generateApron = [&](const NoiseConfig& config, float z)
+	{
+		const FastNoise& runtimeNoise = config.getNoise();
+		TerrainNoise terrainNoise = terrainNoiseOf(runtimeNoise);
+		const int period = VERTEX_COUNT - 1;
+
+		heightGenerator.generateApron(heights, [&](float* out, int width, int height, int x0, int y0, int stride)
+		{
+			if (ANIMATION_SPEED > 0.0f)
+				runtimeNoise.FillSlice3D(out, width, height, x0, y0, z, 1.0f, stride);
+			else if (TILEABLE)
+			{
+				// a tile continues on its other side
+				for (int row = 0; row < height; row++)
+					for (int col = 0; col < width; col++)
+						out[row * stride + col] = heights.at(((x0 + col) % period + period) % period, ((y0 + row) % period + period) % period);
+			}
+			else if (WORLD_CHUNK)
+				runtimeNoise.FillChunk2D(out, width, height, WORLD_CHUNK_X, WORLD_CHUNK_Z, static_cast<float>(period), x0, y0, 1.0f, stride);
+			else if (DOMAIN_WARP)
+				terrainNoise.FillGrid2DWarped(out, width, height, x0, y0, 1.0f, stride, config.getWarp());
+			else if (HIERARCHICAL)
+				runtimeNoise.FillGrid2D(out, width, height, x0, y0, 1.0f, stride);
+			else
+				terrainNoise.FillGrid2D(out, width, height, x0, y0, 1.0f, stride);
+		});
+	};
+
+
+
+	// noiseValues into heights and the vertex heights of mesh, the finite difference normals and the colours into mesh
+	// the height texture mode only needs heights, the shader does the rest
+	auto storeHeights = [&]()
+	{
+		heightQuantizer = HeightQuantizer(heightStats.getMin(), heightStats.getMax());
+
+		int heightPointer = 0;
+		for (int i = 0; i < VERTEX_COUNT; i++) {
+			for (int j = 0; j < VERTEX_COUNT; j++) {
+
+				float noiseValue = noiseValues[heightPointer];
+				if (COMPACT_VERTICES)
+					compactHeights[heightPointer] = heightQuantizer.encode(noiseValue);
+				else if (!HEIGHT_TEXTURE)
+					vertices[heightPointer * vertexStride + 1] = noiseValue;
+				heights.at(j, i) = noiseValue;
+
+				heightPointer++;
+			}
+		}
+	};
+	auto generateNormals = [&]()
+	{
+		if (COMPACT_VERTICES)
+			normalGenerator.generateNormals(heights, compactAttributes);
+		else if (!HEIGHT_TEXTURE)
+			normalGenerator.generateNormals(heights, normals, vertexStride);
+	};
+	auto generateColours = [&]()
+	{
+		if (COMPACT_VERTICES)
+			colorGen.generateColours(heights, heightStats, compactAttributes, 1);
+		else if (!HEIGHT_TEXTURE)
+			colorGen.generateColours(heights, heightStats, colors, vertexStride);
+	};
+
 
 
 	//genereting terrain values
-	int vertexPointer = 0;
-	for (int i = 0; i < VERTEX_COUNT; i++) {
-		for (int j = 0; j < VERTEX_COUNT; j++) {
-			// vertices
-			vertices[vertexPointer * 3 + 0] = (float)j / ((float)VERTEX_COUNT - 1) * VERTEX_SIZE;
-			vertices[vertexPointer * 3 + 2] = (float)i / ((float)VERTEX_COUNT - 1) * VERTEX_SIZE;
-
-			vertexPointer++;
+	if (!COMPACT_VERTICES && !HEIGHT_TEXTURE)
+	{
+		int vertexPointer = 0;
+		for (int i = 0; i < VERTEX_COUNT; i++) {
+			for (int j = 0; j < VERTEX_COUNT; j++) {
+				// vertices
+				vertices[vertexPointer * vertexStride + 0] = (float)j / ((float)VERTEX_COUNT - 1) * VERTEX_SIZE;
+				vertices[vertexPointer * vertexStride + 2] = (float)i / ((float)VERTEX_COUNT - 1) * VERTEX_SIZE;
+
+				vertexPointer++;
+			}
 		}
 	}
 
@@ -152,62 +435,76 @@ int main()
 		}
 	}
 
-	int heightPointer = 0;
-	for (int i = 0; i < VERTEX_COUNT; i++) {
-		for (int j = 0; j < VERTEX_COUNT; j++) {
-
-			float noiseValue = noiseGenerator.GetNoise(j, i);
-			vertices[heightPointer * 3 + 1] = noiseValue;
-			heights[j][i] = noiseValue;
-
-			heightPointer++;
-		}
+	// one snapshot per regeneration, every step of it samples the same noise
+	std::shared_ptr<const NoiseConfig> config = runtimeConfigs.acquire();
+	generateNoise(*config);
+	if (PRINT_DIAGNOSTICS)
+		std::cout << "heights: min " << heightStats.getMin() << ", max " << heightStats.getMax() << ", mean " << heightStats.getMean()
+			<< ", median " << heightStats.getPercentile(0.5f) << std::endl;
+	storeHeights();
+	if (TILEABLE || WORLD_CHUNK || DOMAIN_WARP || HIERARCHICAL || !analyticNormals)
+	{
+		generateApron(*config, 0.0f);
+		generateNormals();
 	}
-	normalGenerator.generateNormals(heights, normals);
-	colorGen.generateColours(heights, 1.0f, colors);
+	generateColours();
 
 	// configure global opengl state
 	// -----------------------------
 
-	unsigned int verticesVBO, normalsVBO, colorsVBO, EBO, VAO;
+	unsigned int EBO, VAO;
 
 	glGenVertexArrays(1, &VAO);
-	glGenBuffers(1, &verticesVBO);
-	glGenBuffers(1, &normalsVBO);
-	glGenBuffers(1, &colorsVBO);
 	glGenBuffers(1, &EBO);
 
 	glBindVertexArray(VAO);
 
-	glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-	glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), vertices, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
-	glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), normals, GL_STATIC_DRAW);
-
-	glBindBuffer(GL_ARRAY_BUFFER, colorsVBO);
-	glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), colors, GL_STATIC_DRAW);
+	// the grid of the height texture mode is the index buffer alone, the VAO has no attributes
+	if (HEIGHT_TEXTURE)
+	{
+		heightTexture.create();
+		heightTexture.upload(heights);
+	}
+	else
+	{
+		mesh.createBuffers();
+		mesh.upload();
+	}
 
 	glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
 	glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * (VERTEX_COUNT - 1) * (VERTEX_COUNT - 1) * sizeof(unsigned int), indices, GL_STATIC_DRAW);
 
-	glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-	glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(0);
-
-	glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
-	glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(1);
-
-	glBindBuffer(GL_ARRAY_BUFFER, colorsVBO);
-	glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-	glEnableVertexAttribArray(2);
-
 
 	glEnable(GL_DEPTH_TEST);
 	glProvokingVertex(GL_FIRST_VERTEX_CONVENTION);
 
 	ourShader.use();
+	if (COMPACT_VERTICES || HEIGHT_TEXTURE)
+	{
+		ourShader.setInt("vertexCount", VERTEX_COUNT);
+		ourShader.setFloat("vertexSize", VERTEX_SIZE);
+	}
+	if (HEIGHT_TEXTURE)
+	{
+		ourShader.setVec2("gridOrigin", 0.0f, 0.0f);
+		ourShader.setInt("heightMap", 0);
+		ourShader.setInt("heightApron", heightTexture.getApron());
+		// the shader's biomeColours array holds at most MAX_BIOMES colours
+		assert(TERRAIN_COLS.size() <= HeightTexture::MAX_BIOMES);
+		const int biomeCount = std::min(static_cast<int>(TERRAIN_COLS.size()), HeightTexture::MAX_BIOMES);
+		for (int i = 0; i < biomeCount; i++)
+			ourShader.setVec3("biomeColours[" + std::to_string(i) + "]", TERRAIN_COLS[i].r / 255.0f, TERRAIN_COLS[i].g / 255.0f, TERRAIN_COLS[i].b / 255.0f);
+		ourShader.setInt("biomeCount", biomeCount);
+		ourShader.setFloat("colourSpread", COLOUR_SPREAD);
+		heightTexture.bind(0);
+	}
+
+	// the benchmark copies the float attributes, the compact layout and the height texture mode have none
+	if (LAYOUT_BENCHMARK_REPEATS > 0 && !COMPACT_VERTICES && !HEIGHT_TEXTURE)
+	{
+		benchmarkVertexLayouts(mesh, EBO, 6 * (VERTEX_COUNT - 1) * (VERTEX_COUNT - 1), LAYOUT_BENCHMARK_REPEATS);
+		glBindVertexArray(VAO);
+	}
 
 	// timing
 	double deltaTime = 0.0f;
@@ -230,51 +527,51 @@ int main()
 		processInput(window, deltaTime);
 		
 		// if true we need to update our draw data
-		if (flag)
+		bool animate = ANIMATION_SPEED > 0.0f;
+		if (flag || animate)
 		{
-			noiseGenerator.SetSeed(static_cast<int>(time(nullptr)));
-			int heightPointer = 0;
-			for (int i = 0; i < VERTEX_COUNT; i++) {
-				for (int j = 0; j < VERTEX_COUNT; j++) {
-
-					float noiseValue = noiseGenerator.GetNoise(j, i);
-					vertices[heightPointer * 3 + 1] = noiseValue;
-					heights[j][i] = noiseValue;
+			if (flag)
+			{
+				seed = static_cast<int>(time(nullptr));
+				warpGenerator.SetSeed(seed + 1);
+				runtimeGenerator.SetSeed(seed);
+				runtimeConfigs.publish(runtimeGenerator, warpGenerator);
+			}
+			config = runtimeConfigs.acquire();
 
-					heightPointer++;
+			// every animation frame is a new slice, not worth caching
+			if (animate)
+			{
+				// the volume keeps octave planes of the noise it was made for, a new snapshot needs a new volume
+				if (!animatedVolume || animatedConfig->getVersion() != config->getVersion())
+				{
+					animatedVolume = std::make_unique<FastNoiseVolume>(config->getNoise(), VERTEX_COUNT, VERTEX_COUNT, 0.0f, 0.0f, 1.0f);
+					animatedConfig = config;
 				}
+				heightGenerator.generateSlice(*animatedVolume, static_cast<float>(currentFrame) * ANIMATION_SPEED, noiseValues, &heightStats);
 			}
+			else
+				generateNoise(*config);
+			storeHeights();
 
-			normalGenerator.generateNormals(heights, normals);
-			colorGen.generateColours(heights, 1.0f, colors);
-
-
-
-			glBindVertexArray(VAO);
-
-			glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-			glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), vertices, GL_STATIC_DRAW);
-
-			glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
-			glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), normals, GL_STATIC_DRAW);
-
-			glBindBuffer(GL_ARRAY_BUFFER, colorsVBO);
-			glBufferData(GL_ARRAY_BUFFER, count * 3 * sizeof(float), colors, GL_STATIC_DRAW);
-
-			glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, EBO);
-			glBufferData(GL_ELEMENT_ARRAY_BUFFER, 6 * (VERTEX_COUNT - 1) * (VERTEX_COUNT - 1) * sizeof(unsigned int), indices, GL_STATIC_DRAW);
+			if (animate || TILEABLE || WORLD_CHUNK || DOMAIN_WARP || HIERARCHICAL || !analyticNormals)
+			{
+				generateApron(*config, static_cast<float>(currentFrame) * ANIMATION_SPEED);
+				generateNormals();
+			}
+			generateColours();
 
-			glBindBuffer(GL_ARRAY_BUFFER, verticesVBO);
-			glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-			glEnableVertexAttribArray(0);
 
-			glBindBuffer(GL_ARRAY_BUFFER, normalsVBO);
-			glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-			glEnableVertexAttribArray(1);
 
-			glBindBuffer(GL_ARRAY_BUFFER, colorsVBO);
-			glVertexAttribPointer(2, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
-			glEnableVertexAttribArray(2);
+			// the indices and attribute pointers don't change, only the vertex data is uploaded again
+			// or only the heights, in the height texture mode
+			if (HEIGHT_TEXTURE)
+				heightTexture.upload(heights);
+			else
+			{
+				glBindVertexArray(VAO);
+				mesh.upload();
+			}
 		}
 
 		// render
@@ -286,6 +583,13 @@ int main()
 		glm::mat4 view = camera.GetViewMatrix();
 		ourShader.setMat4("projection", projection);
 		ourShader.setMat4("view", view);
+		if (COMPACT_VERTICES)
+		{
+			ourShader.setFloat("heightMin", heightQuantizer.getMin());
+			ourShader.setFloat("heightRange", heightQuantizer.getRange());
+		}
+		if (HEIGHT_TEXTURE)
+			ourShader.setFloat("amplitude", heightStats.getAmplitude() > 0.0f ? heightStats.getAmplitude() : 1.0f);
 
 		glBindVertexArray(VAO);
 		glDrawElements(GL_TRIANGLES, 6 * (VERTEX_COUNT - 1) * (VERTEX_COUNT - 1), GL_UNSIGNED_INT, 0);
@@ -294,23 +598,20 @@ int main()
 		glfwPollEvents();
 	}
 
+	if (TILE_CACHE_BYTES > 0 && PRINT_DIAGNOSTICS)
+		std::cout << "tile cache: " << tileCache.getHits() << " hits, " << tileCache.getMisses() << " misses, "
+			<< tileCache.getEvictions() << " evictions, " << tileCache.getBytes() / 1024 << " KiB in " << tileCache.getTileCount() << " tiles" << std::endl;
+
 	// optional: de-allocate all resources once they've outlived their purpose:
 	// ------------------------------------------------------------------------
 
 
-	delete[] vertices;
-	delete[] normals;
 	delete[] indices;
-	delete[] colors;
-
-	for (int i = 0; i < VERTEX_COUNT; i++)
-		delete[] heights[i];
-	delete[] heights;
+	delete[] noiseValues;
 
 	glDeleteVertexArrays(1, &VAO);
-	glDeleteBuffers(1, &verticesVBO);
-	glDeleteBuffers(1, &normalsVBO);
-	glDeleteBuffers(1, &colorsVBO);
+	mesh.deleteBuffers();
+	heightTexture.deleteTexture();
 	glDeleteBuffers(1, &EBO);
 
 	// glfw: terminate, clearing all previously allocated GLFW resources.
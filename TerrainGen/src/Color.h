@@ -3,6 +3,10 @@
 #include <vector>
 #include <cmath>
 
+#include "CompactVertex.h"
+#include "Heightfield.h"
+#include "HeightStats.h"
+
 struct Color
 {
 	float r, g, b;
@@ -29,22 +33,54 @@ public:
 		m_vertexCount(vertexCount)
 	{}
 
-	void generateColours(float** heights, float amplitude, float* colors) const
+	// A colour is 3 floats, the colours of consecutive vertices start stride floats apart
+	void generateColours(const Heightfield& heights, float amplitude, float* colors, int stride = 3) const
+	{
+		coloursFromHeights(heights, amplitude, colors, stride);
+	}
+
+	// The same colours as RGBA8 in the compact vertex layout
+	void generateColours(const Heightfield& heights, float amplitude, CompactAttributes* attributes, int stride = 1) const
+	{
+		coloursFromHeights(heights, amplitude, attributes, stride);
+	}
+
+	// Colours spread over the amplitude the heights really reach, from the stats of their generation
+	template <typename Out>
+	void generateColours(const Heightfield& heights, const HeightStats& stats, Out* colors, int stride) const
+	{
+		float amplitude = stats.getAmplitude();
+		coloursFromHeights(heights, amplitude > 0.0f ? amplitude : 1.0f, colors, stride);
+	}
+
+private:
+	static void store(float* colors, int index, Color c)
+	{
+		colors[index + 0] = c.r;
+		colors[index + 1] = c.g;
+		colors[index + 2] = c.b;
+	}
+
+	static void store(CompactAttributes* attributes, int index, Color c)
+	{
+		encodeColor(c.r, c.g, c.b, attributes[index].color);
+	}
+
+	template <typename Out>
+	void coloursFromHeights(const Heightfield& heights, float amplitude, Out* colors, int stride) const
 	{
 		int pointer = 0;
 		for (int z = 0; z < m_vertexCount; z++)
 		{
+			const float* row = heights.row(z);
 			for (int x = 0; x < m_vertexCount; x++)
 			{
-				Color c = calculateColour(heights[x][z], amplitude);
-				colors[pointer++] = c.r;
-				colors[pointer++] = c.g;
-				colors[pointer++] = c.b;
+				store(colors, pointer, calculateColour(row[x], amplitude));
+				pointer += stride;
 			}
 		}
 	}
 
-private:
 	Color interpolateColours(Color a, Color b, float blend) const
 	{
 		float colorWeight1 = 1.0f - blend;
@@ -0,0 +1,74 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+
+#include "vendor/glm/glm/glm.hpp"
+
+// Per-vertex data of the compact vertex layout, 10 bytes instead of 36
+// x and z aren't stored, vertex_compact.glsl derives them from gl_VertexID like the CPU grid does.
+// Heights are a separate stream of 16-bit unorms over the tile's height range,
+// normal and colour share a second stream of these 8 byte records
+struct CompactAttributes
+{
+	// Octahedral encoding of the normal, 32767 = 1, decoded as integers so every GL version agrees
+	int16_t normal[2];
+	// RGBA8, alpha unused
+	uint8_t color[4];
+};
+
+// Unit normal to 2 x 16 bits: projected onto the octahedron |x| + |y| + |z| = 1 and folded
+// along y, the up axis of the terrain. Matches decodeNormal in vertex_compact.glsl
+inline void encodeNormal(glm::vec3 n, int16_t* out)
+{
+	float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+	float u = n.x / l1;
+	float v = n.z / l1;
+
+	if (n.y < 0.0f)
+	{
+		float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+		float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+		u = foldedU;
+		v = foldedV;
+	}
+
+	out[0] = static_cast<int16_t>(std::lround(u * 32767.0f));
+	out[1] = static_cast<int16_t>(std::lround(v * 32767.0f));
+}
+
+// 0..1 colour channels to RGBA8
+inline void encodeColor(float r, float g, float b, uint8_t* out)
+{
+	auto channel = [](float c) {
+		c = c < 0.0f ? 0.0f : c > 1.0f ? 1.0f : c;
+		return static_cast<uint8_t>(std::lround(c * 255.0f));
+	};
+	out[0] = channel(r);
+	out[1] = channel(g);
+	out[2] = channel(b);
+	out[3] = 255;
+}
+
+// Heights between min and max to 16-bit unorms, the shader gets min and getRange() back as uniforms
+class HeightQuantizer
+{
+	float m_min;
+	float m_range;
+	float m_scale;
+
+public:
+	HeightQuantizer(float min, float max)
+		:m_min(min), m_range(max > min ? max - min : 1.0f), m_scale(65535.0f / m_range)
+	{}
+
+	uint16_t encode(float height) const
+	{
+		float q = (height - m_min) * m_scale;
+		q = q < 0.0f ? 0.0f : q > 65535.0f ? 65535.0f : q;
+		return static_cast<uint16_t>(q + 0.5f);
+	}
+
+	float getMin() const { return m_min; }
+	float getRange() const { return m_range; }
+};
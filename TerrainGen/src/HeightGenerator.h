@@ -0,0 +1,272 @@
+#pragma once
+
+#include <algorithm>
+#include <type_traits>
+#include <vector>
+
+#include "ThreadPool.h"
+#include "Heightfield.h"
+#include "HeightStats.h"
+#include "NormalGenerator.h"
+#include "vendor/noise/FastNoise.h"
+#include "vendor/noise/FastNoiseVolume.h"
+
+// Fills the VERTEX_COUNT x VERTEX_COUNT noise grid on a ThreadPool
+// The grid is cut into bands of whole rows, every band is one FillGrid2D call
+// Sample coordinates don't depend on the banding, so the result is the same for any worker or band count
+// Given a HeightStats, every band adds its heights to its own stats right after filling them and the
+// bands are merged at the end, the stats cost no extra pass over the grid
+class HeightGenerator
+{
+	const int m_vertexCount;
+	int m_bandRows;
+	ThreadPool& m_pool;
+
+public:
+	// band_rows = 0 picks a band size that gives every worker a few bands to balance the load
+	HeightGenerator(int vertex_count, ThreadPool& pool, int band_rows = 0)
+		:m_vertexCount(vertex_count), m_bandRows(band_rows), m_pool(pool)
+	{
+		if (m_bandRows <= 0)
+		{
+			int bands = static_cast<int>(m_pool.size()) * 4;
+			m_bandRows = (m_vertexCount + bands - 1) / bands;
+		}
+		if (m_bandRows < 1)
+			m_bandRows = 1;
+	}
+
+	// heights is row major, heights[z * vertexCount + x] = noise(x, z)
+	// Noise is FastNoise or a StaticNoise, anything with a const FillGrid2D
+	template <typename Noise>
+	void generateHeights(const Noise& noise, float* heights, HeightStats* stats = nullptr) const
+	{
+		int bandCount = (m_vertexCount + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, m_vertexCount - firstRow);
+
+			noise.FillGrid2D(heights + firstRow * m_vertexCount, m_vertexCount, rows,
+				0.0f, static_cast<float>(firstRow), 1.0f, m_vertexCount);
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// Heights and normals in one pass, the normals come from the noise's analytic gradient
+	// Noise needs FillGrid2DWithGradient, normals gets a normal per sample in the order of heights,
+	// normalStride elements apart, 0 = packed: 3 floats or one CompactAttributes per normal
+	template <typename Noise, typename Normal>
+	void generateHeightsAndNormals(const Noise& noise, const NormalGenerator& normalGenerator, float* heights, Normal* normals,
+		HeightStats* stats = nullptr, int normalStride = 0) const
+	{
+		if (normalStride == 0)
+			normalStride = std::is_same<Normal, float>::value ? 3 : 1;
+		int bandCount = (m_vertexCount + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, m_vertexCount - firstRow);
+			int first = firstRow * m_vertexCount;
+			int count = rows * m_vertexCount;
+
+			std::vector<float> gradient(count * 2);
+			float* dx = gradient.data();
+			float* dz = dx + count;
+
+			noise.FillGrid2DWithGradient(heights + first, dx, dz, m_vertexCount, rows,
+				0.0f, static_cast<float>(firstRow), 1.0f, m_vertexCount);
+			normalGenerator.generateNormals(dx, dz, count, normals + first * normalStride, normalStride);
+			if (stats)
+				bands[band].add(heights + first, count);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// Heights sampled at positions moved by warp.GradientPerturbFractal, one FillGrid2DWarped per band
+	// Noise needs FillGrid2DWarped, the warp itself runs on FastNoise's batch kernels
+	template <typename Noise>
+	void generateWarpedHeights(const Noise& noise, const FastNoise& warp, float* heights, HeightStats* stats = nullptr) const
+	{
+		int bandCount = (m_vertexCount + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, m_vertexCount - firstRow);
+
+			noise.FillGrid2DWarped(heights + firstRow * m_vertexCount, m_vertexCount, rows,
+				0.0f, static_cast<float>(firstRow), 1.0f, m_vertexCount, warp);
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// Heights with the octaves below splitFrequency evaluated on every coarseStep-th vertex only,
+	// one FillGrid2DHierarchical per band. Bands are rounded up to whole coarse steps so each band's
+	// coarse grid lines up with the others, the result is still independent of the banding
+	void generateHierarchicalHeights(const FastNoise& noise, float splitFrequency, int coarseStep, float* heights, HeightStats* stats = nullptr) const
+	{
+		int bandRows = std::max(coarseStep, 1);
+		bandRows *= (m_bandRows + bandRows - 1) / bandRows;
+		int bandCount = (m_vertexCount + bandRows - 1) / bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * bandRows;
+			int rows = std::min(bandRows, m_vertexCount - firstRow);
+
+			noise.FillGrid2DHierarchical(heights + firstRow * m_vertexCount, m_vertexCount, rows,
+				0.0f, static_cast<float>(firstRow), 1.0f, m_vertexCount, splitFrequency, coarseStep);
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// Heights from the z slice of 3D noise, one FillSlice3D per band
+	// Stateless, the FastNoiseVolume overload reuses work between slices
+	void generateSlice(const FastNoise& noise, float z, float* heights, HeightStats* stats = nullptr) const
+	{
+		int bandCount = (m_vertexCount + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, m_vertexCount - firstRow);
+
+			noise.FillSlice3D(heights + firstRow * m_vertexCount, m_vertexCount, rows,
+				0.0f, static_cast<float>(firstRow), z, 1.0f, m_vertexCount);
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// Heights from the z slice of volume: the planes the slice needs are evaluated once, then every band
+	// is one FillSliceRows. volume must be over the vertexCount x vertexCount grid at integer coordinates
+	void generateSlice(FastNoiseVolume& volume, float z, float* heights, HeightStats* stats = nullptr) const
+	{
+		volume.PrepareSlice(z);
+
+		int bandCount = (m_vertexCount + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, m_vertexCount - firstRow);
+
+			volume.FillSliceRows(heights + firstRow * m_vertexCount, z, firstRow, rows, m_vertexCount);
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// Heights of a tile that wraps on both axes, one FillTile2D per band
+	// The period is vertexCount - 1, the last row and column repeat the first ones so copies
+	// of the mesh placed side by side share their edges
+	void generateTile(const FastNoise& noise, float* heights, HeightStats* stats = nullptr) const
+	{
+		int period = m_vertexCount - 1;
+		int bandCount = (period + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, period - firstRow);
+
+			noise.FillTile2D(heights + firstRow * m_vertexCount, period, period, firstRow, rows, m_vertexCount);
+			for (int row = firstRow; row < firstRow + rows; row++)
+				heights[row * m_vertexCount + period] = heights[row * m_vertexCount];
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+
+		std::copy(heights, heights + m_vertexCount, heights + period * m_vertexCount);
+		if (stats)
+			stats->add(heights + period * m_vertexCount, m_vertexCount);
+	}
+
+	// Heights of world chunk (chunkX, chunkZ), one FillChunk2D per band
+	// Chunks are vertexCount - 1 units wide, so neighbouring chunks share their edge vertices.
+	// The chunk origin never goes through float math, far chunks keep the detail of chunk 0
+	void generateChunk(const FastNoise& noise, int chunkX, int chunkZ, float* heights, HeightStats* stats = nullptr) const
+	{
+		float chunkSize = static_cast<float>(m_vertexCount - 1);
+		int bandCount = (m_vertexCount + m_bandRows - 1) / m_bandRows;
+		std::vector<HeightStats> bands = bandStats(stats, bandCount);
+
+		m_pool.parallelFor(bandCount, [&](int band) {
+			int firstRow = band * m_bandRows;
+			int rows = std::min(m_bandRows, m_vertexCount - firstRow);
+
+			noise.FillChunk2D(heights + firstRow * m_vertexCount, m_vertexCount, rows, chunkX, chunkZ, chunkSize,
+				0.0f, static_cast<float>(firstRow), 1.0f, m_vertexCount);
+			if (stats)
+				bands[band].add(heights + firstRow * m_vertexCount, rows * m_vertexCount);
+		});
+
+		mergeStats(stats, bands);
+	}
+
+	// The apron of heights, the samples around its vertexCount x vertexCount interior, from the function
+	// the interior was generated with: fill(out, width, height, x0, y0, stride) writes width x height
+	// samples at grid coordinates x0 + col, y0 + row to out[row * stride + col]
+	// Four strips: the rows above and below, corners included, then the columns left and right
+	template <typename Fill>
+	void generateApron(Heightfield& heights, Fill fill) const
+	{
+		int apron = heights.getApron();
+		if (apron <= 0)
+			return;
+
+		int stride = heights.getStride();
+		int width = m_vertexCount + 2 * apron;
+
+		fill(&heights.at(-apron, -apron), width, apron, -apron, -apron, stride);
+		fill(&heights.at(-apron, m_vertexCount), width, apron, -apron, m_vertexCount, stride);
+		fill(&heights.at(-apron, 0), apron, m_vertexCount, -apron, 0, stride);
+		fill(&heights.at(m_vertexCount, 0), apron, m_vertexCount, m_vertexCount, 0, stride);
+	}
+
+	int getBandRows() const
+	{
+		return m_bandRows;
+	}
+
+private:
+	// Empty stats with the histogram range of stats, one per band, none without stats
+	static std::vector<HeightStats> bandStats(const HeightStats* stats, int bandCount)
+	{
+		if (!stats)
+			return {};
+
+		HeightStats empty = *stats;
+		empty.clear();
+		return std::vector<HeightStats>(bandCount, empty);
+	}
+
+	static void mergeStats(HeightStats* stats, const std::vector<HeightStats>& bands)
+	{
+		if (!stats)
+			return;
+
+		stats->clear();
+		for (const HeightStats& band : bands)
+			stats->merge(band);
+	}
+};
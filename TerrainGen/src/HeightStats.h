@@ -0,0 +1,139 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <limits>
+#include <vector>
+
+// Running min, max, mean and histogram of heights, collected while they are generated
+// The histogram covers a fixed range split into equal bins, heights outside it land in the first
+// or last bin. Stats of separate parts of a tile merge into the stats of the whole tile
+class HeightStats
+{
+	float m_histogramMin;
+	float m_binScale;
+	std::vector<uint32_t> m_bins;
+
+	float m_min = std::numeric_limits<float>::max();
+	float m_max = std::numeric_limits<float>::lowest();
+	double m_sum = 0.0;
+	size_t m_count = 0;
+
+public:
+	// FastNoise fractals are scaled to about -1..1, the default histogram range
+	explicit HeightStats(float histogramMin = -1.0f, float histogramMax = 1.0f, int binCount = 64)
+		:m_histogramMin(histogramMin), m_binScale(binCount / (histogramMax - histogramMin)), m_bins(std::max(binCount, 1))
+	{}
+
+	// Forgets the samples, keeps the histogram range
+	void clear()
+	{
+		std::fill(m_bins.begin(), m_bins.end(), 0u);
+		m_min = std::numeric_limits<float>::max();
+		m_max = std::numeric_limits<float>::lowest();
+		m_sum = 0.0;
+		m_count = 0;
+	}
+
+	// One pass over heights, meant to run on samples that were just written and are still in cache
+	void add(const float* heights, size_t count)
+	{
+		int lastBin = static_cast<int>(m_bins.size()) - 1;
+		float min = m_min;
+		float max = m_max;
+		double sum = 0.0;
+
+		for (size_t i = 0; i < count; i++)
+		{
+			float height = heights[i];
+			min = std::min(min, height);
+			max = std::max(max, height);
+			sum += height;
+
+			int bin = static_cast<int>((height - m_histogramMin) * m_binScale);
+			m_bins[bin < 0 ? 0 : bin > lastBin ? lastBin : bin]++;
+		}
+
+		m_min = min;
+		m_max = max;
+		m_sum += sum;
+		m_count += count;
+	}
+
+	// Adds the samples of other, which must have the same histogram range and bin count
+	void merge(const HeightStats& other)
+	{
+		for (size_t i = 0; i < m_bins.size(); i++)
+			m_bins[i] += other.m_bins[i];
+
+		m_min = std::min(m_min, other.m_min);
+		m_max = std::max(m_max, other.m_max);
+		m_sum += other.m_sum;
+		m_count += other.m_count;
+	}
+
+	// Floats written by write, to keep the stats next to the heights of a cached tile
+	size_t floatCount() const
+	{
+		return 4 + m_bins.size();
+	}
+
+	// Bin counts go through float exactly up to 2^24 samples per bin
+	void write(float* out) const
+	{
+		out[0] = m_min;
+		out[1] = m_max;
+		out[2] = static_cast<float>(getMean());
+		out[3] = static_cast<float>(m_count);
+		for (size_t i = 0; i < m_bins.size(); i++)
+			out[4 + i] = static_cast<float>(m_bins[i]);
+	}
+
+	void read(const float* in)
+	{
+		m_min = in[0];
+		m_max = in[1];
+		m_count = static_cast<size_t>(in[3]);
+		m_sum = static_cast<double>(in[2]) * m_count;
+		for (size_t i = 0; i < m_bins.size(); i++)
+			m_bins[i] = static_cast<uint32_t>(in[4 + i]);
+	}
+
+	bool empty() const { return m_count == 0; }
+	size_t getCount() const { return m_count; }
+	float getMin() const { return m_min; }
+	float getMax() const { return m_max; }
+	double getMean() const { return m_count > 0 ? m_sum / m_count : 0.0; }
+
+	// Largest distance from 0, the amplitude ColourGenerator maps its colours to
+	float getAmplitude() const
+	{
+		return empty() ? 0.0f : std::max(std::fabs(m_min), std::fabs(m_max));
+	}
+
+	int getBinCount() const { return static_cast<int>(m_bins.size()); }
+	uint32_t getBin(int bin) const { return m_bins[bin]; }
+	float getBinMin(int bin) const { return m_histogramMin + bin / m_binScale; }
+
+	// Height below which about fraction of the samples lie, to the resolution of the bins
+	// Clamped to the real min and max, so the edge bins don't widen the answer
+	float getPercentile(float fraction) const
+	{
+		if (empty())
+			return 0.0f;
+
+		double target = fraction * m_count;
+		double below = 0.0;
+		for (int bin = 0; bin < getBinCount(); bin++)
+		{
+			if (below + m_bins[bin] >= target && m_bins[bin] > 0)
+			{
+				float height = getBinMin(bin) + static_cast<float>((target - below) / m_bins[bin]) / m_binScale;
+				return std::min(std::max(height, m_min), m_max);
+			}
+			below += m_bins[bin];
+		}
+		return m_max;
+	}
+};
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <glad/glad.h>
+
+#include "Heightfield.h"
+
+// The heights of the terrain in a GL_R32F texture, for vertex_heightmap.glsl
+// The texture holds the apron of the Heightfield too, texel (x + apron, z + apron) is heights.at(x, z),
+// so the shader's normal stencil reads the same neighbours NormalGenerator does
+// A new terrain is one glTexSubImage2D of the heightfield rows, the grid mesh drawn with it never changes
+class HeightTexture
+{
+	const int m_width;
+	const int m_height;
+	const int m_apron;
+	unsigned int m_texture = 0;
+
+public:
+	// Size of the biomeColours array in vertex_heightmap.glsl, keep the two in step
+	static constexpr int MAX_BIOMES = 8;
+
+	HeightTexture(int width, int height, int apron)
+		:m_width(width + 2 * apron), m_height(height + 2 * apron), m_apron(apron)
+	{}
+
+	HeightTexture(const HeightTexture&) = delete;
+	HeightTexture& operator=(const HeightTexture&) = delete;
+
+	int getApron() const { return m_apron; }
+
+	// Allocates the texture, unfiltered, the shader reads it with texelFetch
+	void create()
+	{
+		glGenTextures(1, &m_texture);
+		glBindTexture(GL_TEXTURE_2D, m_texture);
+		glTexImage2D(GL_TEXTURE_2D, 0, GL_R32F, m_width, m_height, 0, GL_RED, GL_FLOAT, nullptr);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+		glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+	}
+
+	void deleteTexture()
+	{
+		if (m_texture)
+			glDeleteTextures(1, &m_texture);
+		m_texture = 0;
+	}
+
+	// Copies heights, apron included, straight from its padded rows
+	// heights needs at least the apron the texture was made with
+	void upload(const Heightfield& heights)
+	{
+		glBindTexture(GL_TEXTURE_2D, m_texture);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, heights.getStride());
+		glTexSubImage2D(GL_TEXTURE_2D, 0, 0, 0, m_width, m_height, GL_RED, GL_FLOAT, heights.row(-m_apron) - m_apron);
+		glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	}
+
+	void bind(unsigned int unit) const
+	{
+		glActiveTexture(GL_TEXTURE0 + unit);
+		glBindTexture(GL_TEXTURE_2D, m_texture);
+	}
+};
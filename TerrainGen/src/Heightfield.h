@@ -0,0 +1,106 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <new>
+
+// Row-major grid of heights in one allocation, at(x, z) is row(z)[x]
+// Every row starts on an ALIGNMENT byte boundary, the stride is the width rounded up to that,
+// so a pass over the rows walks memory linearly and vector loads of a row start aligned
+//
+// An apron of samples can surround the width x height interior: x and z then also go from -apron
+// to width + apron - 1 and height + apron - 1. Neighbour stencils read the apron instead of clamping.
+// The interior rows stay aligned, the apron sits in the padding before them
+class Heightfield
+{
+	int m_width = 0;
+	int m_height = 0;
+	int m_apron = 0;
+	int m_stride = 0;
+	// Offset of at(0, 0) from the start of the allocation
+	size_t m_origin = 0;
+	size_t m_size = 0;
+	float* m_data = nullptr;
+
+	void release()
+	{
+		if (m_data)
+			::operator delete(m_data, std::align_val_t(ALIGNMENT));
+		m_data = nullptr;
+	}
+
+public:
+	static const int ALIGNMENT = 64;
+	static const int ROW_ALIGN = ALIGNMENT / sizeof(float);
+
+	Heightfield() = default;
+
+	// Zero filled, apron and padding included
+	Heightfield(int width, int height, int apron = 0)
+		:m_width(width), m_height(height), m_apron(apron)
+	{
+		int leftPadding = (apron + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+		m_stride = (leftPadding + width + apron + ROW_ALIGN - 1) / ROW_ALIGN * ROW_ALIGN;
+		m_origin = static_cast<size_t>(apron) * m_stride + leftPadding;
+		m_size = static_cast<size_t>(m_stride) * (height + 2 * apron);
+
+		m_data = static_cast<float*>(::operator new(m_size * sizeof(float), std::align_val_t(ALIGNMENT)));
+		std::fill(m_data, m_data + m_size, 0.0f);
+	}
+
+	~Heightfield()
+	{
+		release();
+	}
+
+	Heightfield(const Heightfield&) = delete;
+	Heightfield& operator=(const Heightfield&) = delete;
+
+	Heightfield(Heightfield&& other) noexcept
+		:m_width(other.m_width), m_height(other.m_height), m_apron(other.m_apron), m_stride(other.m_stride),
+		m_origin(other.m_origin), m_size(other.m_size), m_data(other.m_data)
+	{
+		other.m_data = nullptr;
+	}
+
+	Heightfield& operator=(Heightfield&& other) noexcept
+	{
+		if (this != &other)
+		{
+			release();
+			m_width = other.m_width;
+			m_height = other.m_height;
+			m_apron = other.m_apron;
+			m_stride = other.m_stride;
+			m_origin = other.m_origin;
+			m_size = other.m_size;
+			m_data = other.m_data;
+			other.m_data = nullptr;
+		}
+		return *this;
+	}
+
+	// Copies the width x height interior from a row-major source whose rows are srcStride floats apart
+	void copyFrom(const float* src, int srcStride)
+	{
+		for (int z = 0; z < m_height; z++)
+			std::copy(src + static_cast<size_t>(z) * srcStride, src + static_cast<size_t>(z) * srcStride + m_width, row(z));
+	}
+
+	// z and x can be negative within the apron
+	float* row(int z) { return m_data + m_origin + static_cast<ptrdiff_t>(z) * m_stride; }
+	const float* row(int z) const { return m_data + m_origin + static_cast<ptrdiff_t>(z) * m_stride; }
+
+	float& at(int x, int z) { return row(z)[x]; }
+	float at(int x, int z) const { return row(z)[x]; }
+
+	// at(0, 0), the first interior sample
+	float* data() { return row(0); }
+	const float* data() const { return row(0); }
+
+	int getWidth() const { return m_width; }
+	int getHeight() const { return m_height; }
+	int getApron() const { return m_apron; }
+	// Floats between the starts of two rows
+	int getStride() const { return m_stride; }
+};
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+
+#include "vendor/noise/FastNoise.h"
+
+// Immutable copy of a FastNoise's settings, with its permutation tables, fractal bounding and
+// active octaves already computed by the setters. Only the const FastNoise interface is exposed,
+// and const FastNoise methods keep no state, so any number of threads can sample one config at once.
+// The cellular lookup noise is copied too, the config doesn't point into the FastNoise it was made from
+// A config also holds the warp noise the terrain noise is sampled through, so one snapshot covers
+// everything a generation job reads. The warp only runs GradientPerturb, its cellular lookup is dropped
+class NoiseConfig
+{
+	FastNoise m_noise;
+	FastNoise m_cellularLookup;
+	FastNoise m_warp;
+	uint64_t m_version;
+
+public:
+	NoiseConfig(const FastNoise& noise, const FastNoise& warp, uint64_t version)
+		:m_noise(noise), m_warp(warp), m_version(version)
+	{
+		if (const FastNoise* lookup = noise.GetCellularNoiseLookup())
+		{
+			m_cellularLookup = *lookup;
+			m_noise.SetCellularNoiseLookup(&m_cellularLookup);
+		}
+		m_warp.SetCellularNoiseLookup(nullptr);
+	}
+
+	// The object holds a pointer to its own lookup copy
+	NoiseConfig(const NoiseConfig&) = delete;
+	NoiseConfig& operator=(const NoiseConfig&) = delete;
+
+	const FastNoise& getNoise() const { return m_noise; }
+	const FastNoise& getWarp() const { return m_warp; }
+
+	// Increases with every publish, a worker can tell a newer config from the one it holds
+	uint64_t getVersion() const { return m_version; }
+};
+
+// The current NoiseConfig of a generator. One thread edits its own FastNoise objects and publishes a snapshot
+// of them, generation threads acquire the latest snapshot once per job and sample it without locks.
+// A published config is never modified, it is freed when the last job holding it drops it
+class NoiseConfigPublisher
+{
+	std::shared_ptr<const NoiseConfig> m_current;
+	uint64_t m_nextVersion = 1;
+
+public:
+	NoiseConfigPublisher(const FastNoise& noise, const FastNoise& warp)
+	{
+		publish(noise, warp);
+	}
+
+	// Snapshots noise and warp and makes them the current config, from the thread that owns them
+	void publish(const FastNoise& noise, const FastNoise& warp)
+	{
+		std::shared_ptr<const NoiseConfig> config = std::make_shared<const NoiseConfig>(noise, warp, m_nextVersion++);
+		std::atomic_store(&m_current, std::move(config));
+	}
+
+	// The latest published config, from any thread
+	std::shared_ptr<const NoiseConfig> acquire() const
+	{
+		return std::atomic_load(&m_current);
+	}
+};
@@ -1,4 +1,7 @@
+#pragma once
 
+#include "CompactVertex.h"
+#include "Heightfield.h"
 
 class NormalGenerator
 {
@@ -9,30 +12,101 @@ public:
 		:m_vertexCount(vertex_count)
 	{}
 
-	void generateNormals(float** heights, float* normals) const
+	// Finite difference normals of the vertexCount x vertexCount interior of heights
+	// With an apron the edge vertices see their real neighbours and the loop has no clamping,
+	// without one the edge heights are repeated outwards
+	// A normal is 3 floats, the normals of consecutive vertices start stride floats apart
+	void generateNormals(const Heightfield& heights, float* normals, int stride = 3) const
 	{
+		normalsFromHeights(heights, normals, stride);
+	}
+
+	// The same normals octahedral encoded into the compact vertex layout
+	void generateNormals(const Heightfield& heights, CompactAttributes* attributes, int stride = 1) const
+	{
+		normalsFromHeights(heights, attributes, stride);
+	}
+
+	// Normals of the surface y = noise(x, z) from its analytic gradient, no neighbour reads
+	// dx and dz are the height change per grid step, the scale calculateNormal works in
+	void generateNormals(const float* dx, const float* dz, int count, float* normals, int stride = 3) const
+	{
+		normalsFromGradient(dx, dz, count, normals, stride);
+	}
+
+	void generateNormals(const float* dx, const float* dz, int count, CompactAttributes* attributes, int stride = 1) const
+	{
+		normalsFromGradient(dx, dz, count, attributes, stride);
+	}
+private:
+
+	static void store(float* normals, int index, glm::vec3 norm)
+	{
+		normals[index + 0] = norm.x;
+		normals[index + 1] = norm.y;
+		normals[index + 2] = norm.z;
+	}
+
+	static void store(CompactAttributes* attributes, int index, glm::vec3 norm)
+	{
+		encodeNormal(norm, attributes[index].normal);
+	}
+
+	template <typename Out>
+	void normalsFromHeights(const Heightfield& heights, Out* normals, int stride) const
+	{
+		if (heights.getApron() >= 1)
+		{
+			normalsFromInterior(heights, normals, stride);
+			return;
+		}
+
 		int pointer = 0;
 		for (int z = 0; z < m_vertexCount; z++) {
 			for (int x = 0; x < m_vertexCount; x++) {
-				glm::vec3 norm = calculateNormal(x, z, heights);
-				normals[pointer++] = norm.x;
-				normals[pointer++] = norm.y;
-				normals[pointer++] = norm.z;
+				store(normals, pointer, calculateNormal(x, z, heights));
+				pointer += stride;
 			}
 		}
 	}
-private:
 
-	float getHeight(int x, int z, float** heights) const
+	// Same stencil as calculateNormal, every neighbour is inside the heightfield
+	template <typename Out>
+	void normalsFromInterior(const Heightfield& heights, Out* normals, int stride) const
+	{
+		int pointer = 0;
+		for (int z = 0; z < m_vertexCount; z++) {
+			const float* rowD = heights.row(z - 1);
+			const float* row = heights.row(z);
+			const float* rowU = heights.row(z + 1);
+
+			for (int x = 0; x < m_vertexCount; x++) {
+				store(normals, pointer, glm::normalize(glm::vec3(row[x - 1] - row[x + 1], 2.f, rowD[x] - rowU[x])));
+				pointer += stride;
+			}
+		}
+	}
+
+	template <typename Out>
+	void normalsFromGradient(const float* dx, const float* dz, int count, Out* normals, int stride) const
+	{
+		int pointer = 0;
+		for (int i = 0; i < count; i++) {
+			store(normals, pointer, glm::normalize(glm::vec3(-dx[i], 1.f, -dz[i])));
+			pointer += stride;
+		}
+	}
+
+	float getHeight(int x, int z, const Heightfield& heights) const
 	{
 		x = x < 0 ? 0 : x;
 		z = z < 0 ? 0 : z;
 		x = x >= m_vertexCount ? m_vertexCount - 1 : x;
 		z = z >= m_vertexCount ? m_vertexCount - 1 : z;
-		return heights[z][x];
+		return heights.at(x, z);
 	}
 
-	glm::vec3 calculateNormal(int x, int z, float** heights) const
+	glm::vec3 calculateNormal(int x, int z, const Heightfield& heights) const
 	{
 		float heightL = getHeight(x - 1, z, heights);
 		float heightR = getHeight(x + 1, z, heights);
@@ -0,0 +1,139 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "CompactVertex.h"
+
+// The per-vertex attributes of the terrain mesh and the buffers they are drawn from
+// Separate: positions, normals and colours in three tightly packed arrays, one VBO each
+// Interleaved: position, normal and colour of a vertex next to each other, one array and one VBO,
+// a vertex fetch reads one 36 byte run instead of three 12 byte reads from different buffers
+// Compact: 10 bytes per vertex for vertex_compact.glsl, 16-bit heights in one VBO and the
+// CompactAttributes normal and colour in another, x and z come from the vertex index
+// The generators write straight into the arrays. In the float layouts each attribute is 3 floats every
+// getStride() floats, in Compact heights() has one value and attributes() one record per vertex
+// Attribute locations 0, 1 and 2 are position (height), normal and colour, as in the shaders
+class TerrainVertices
+{
+public:
+	enum Layout { Separate, Interleaved, Compact };
+
+private:
+	const Layout m_layout;
+	const int m_count;
+	std::vector<float> m_data;
+	std::vector<uint16_t> m_heights;
+	std::vector<CompactAttributes> m_attributes;
+	unsigned int m_buffers[3] = {};
+
+	int bufferCount() const { return m_layout == Interleaved ? 1 : m_layout == Compact ? 2 : 3; }
+
+public:
+	TerrainVertices(int count, Layout layout)
+		:m_layout(layout), m_count(count), m_data(layout == Compact ? 0 : static_cast<size_t>(count) * 9),
+		m_heights(layout == Compact ? count : 0), m_attributes(layout == Compact ? count : 0)
+	{}
+
+	TerrainVertices(const TerrainVertices&) = delete;
+	TerrainVertices& operator=(const TerrainVertices&) = delete;
+
+	// Separate and Interleaved
+	float* positions() { return m_data.data(); }
+	float* normals() { return m_data.data() + (m_layout == Interleaved ? 3 : m_count * 3); }
+	float* colors() { return m_data.data() + (m_layout == Interleaved ? 6 : m_count * 6); }
+
+	// Compact
+	uint16_t* heights() { return m_heights.data(); }
+	CompactAttributes* attributes() { return m_attributes.data(); }
+
+	// Elements from an attribute of one vertex to the same attribute of the next: floats, or records in Compact
+	int getStride() const { return m_layout == Interleaved ? 9 : m_layout == Compact ? 1 : 3; }
+	Layout getLayout() const { return m_layout; }
+	int getCount() const { return m_count; }
+
+	size_t getBytesPerVertex() const
+	{
+		return m_layout == Compact ? sizeof(uint16_t) + sizeof(CompactAttributes) : 9 * sizeof(float);
+	}
+
+	// Creates the VBOs and points the attributes of the bound VAO at them
+	void createBuffers()
+	{
+		glGenBuffers(bufferCount(), m_buffers);
+
+		if (m_layout == Compact)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffers[0]);
+			glVertexAttribPointer(0, 1, GL_UNSIGNED_SHORT, GL_TRUE, sizeof(uint16_t), (void*)0);
+			glEnableVertexAttribArray(0);
+
+			GLsizei stride = sizeof(CompactAttributes);
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffers[1]);
+			glVertexAttribIPointer(1, 2, GL_SHORT, stride, (void*)offsetof(CompactAttributes, normal));
+			glEnableVertexAttribArray(1);
+			glVertexAttribPointer(2, 4, GL_UNSIGNED_BYTE, GL_TRUE, stride, (void*)offsetof(CompactAttributes, color));
+			glEnableVertexAttribArray(2);
+		}
+		else if (m_layout == Interleaved)
+		{
+			GLsizei stride = 9 * sizeof(float);
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffers[0]);
+			for (int attribute = 0; attribute < 3; attribute++)
+			{
+				glVertexAttribPointer(attribute, 3, GL_FLOAT, GL_FALSE, stride, (void*)(attribute * 3 * sizeof(float)));
+				glEnableVertexAttribArray(attribute);
+			}
+		}
+		else
+		{
+			for (int attribute = 0; attribute < 3; attribute++)
+			{
+				glBindBuffer(GL_ARRAY_BUFFER, m_buffers[attribute]);
+				glVertexAttribPointer(attribute, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), (void*)0);
+				glEnableVertexAttribArray(attribute);
+			}
+		}
+	}
+
+	void deleteBuffers()
+	{
+		if (m_buffers[0])
+			glDeleteBuffers(bufferCount(), m_buffers);
+		m_buffers[0] = 0;
+	}
+
+	// The attributes of other, both in one of the float layouts
+	void copyFrom(TerrainVertices& other)
+	{
+		float* attributes[3] = { positions(), normals(), colors() };
+		float* otherAttributes[3] = { other.positions(), other.normals(), other.colors() };
+
+		for (int attribute = 0; attribute < 3; attribute++)
+			for (int i = 0; i < m_count; i++)
+				for (int c = 0; c < 3; c++)
+					attributes[attribute][i * getStride() + c] = otherAttributes[attribute][i * other.getStride() + c];
+	}
+
+	// Copies the arrays to the VBOs, the attribute pointers stay as createBuffers set them
+	void upload()
+	{
+		if (m_layout == Compact)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffers[0]);
+			glBufferData(GL_ARRAY_BUFFER, m_heights.size() * sizeof(uint16_t), m_heights.data(), GL_STATIC_DRAW);
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffers[1]);
+			glBufferData(GL_ARRAY_BUFFER, m_attributes.size() * sizeof(CompactAttributes), m_attributes.data(), GL_STATIC_DRAW);
+			return;
+		}
+
+		size_t bytes = m_data.size() * sizeof(float) / bufferCount();
+		for (int buffer = 0; buffer < bufferCount(); buffer++)
+		{
+			glBindBuffer(GL_ARRAY_BUFFER, m_buffers[buffer]);
+			glBufferData(GL_ARRAY_BUFFER, bytes, m_data.data() + buffer * m_count * 3, GL_STATIC_DRAW);
+		}
+	}
+};
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Fixed set of worker threads for data parallel jobs
+// parallelFor() hands out indices to the workers and the calling thread until all are done
+class ThreadPool
+{
+	std::vector<std::thread> m_workers;
+
+	std::mutex m_mutex;
+	std::condition_variable m_wake;
+	std::condition_variable m_done;
+
+	// current job, guarded by m_mutex except for the atomic counters
+	const std::function<void(int)>* m_task = nullptr;
+	int m_taskCount = 0;
+	std::atomic<int> m_nextIndex{ 0 };
+	std::atomic<int> m_finished{ 0 };
+	unsigned m_generation = 0;
+	int m_busyWorkers = 0;
+	bool m_stop = false;
+
+public:
+	// threadCount is the total number of threads working on a job, including the caller
+	// 0 uses one thread per hardware thread
+	explicit ThreadPool(unsigned threadCount = 0)
+	{
+		if (threadCount == 0)
+			threadCount = std::thread::hardware_concurrency();
+		if (threadCount == 0)
+			threadCount = 1;
+
+		for (unsigned i = 1; i < threadCount; i++)
+			m_workers.emplace_back([this] { workerLoop(); });
+	}
+
+	~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_stop = true;
+		}
+		m_wake.notify_all();
+
+		for (std::thread& worker : m_workers)
+			worker.join();
+	}
+
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	unsigned size() const
+	{
+		return static_cast<unsigned>(m_workers.size()) + 1;
+	}
+
+	// Runs task(i) for every i in [0, count) and returns once all of them finished
+	// Not reentrant, task must not call parallelFor on the same pool
+	void parallelFor(int count, const std::function<void(int)>& task)
+	{
+		if (count <= 0)
+			return;
+
+		if (m_workers.empty() || count == 1)
+		{
+			for (int i = 0; i < count; i++)
+				task(i);
+			return;
+		}
+
+		{
+			std::lock_guard<std::mutex> lock(m_mutex);
+			m_task = &task;
+			m_taskCount = count;
+			m_nextIndex = 0;
+			m_finished = 0;
+			m_generation++;
+		}
+		m_wake.notify_all();
+
+		runTasks(task, count);
+
+		// workers still holding the task pointer must let go before it goes out of scope
+		std::unique_lock<std::mutex> lock(m_mutex);
+		m_done.wait(lock, [this, count] { return m_finished == count && m_busyWorkers == 0; });
+		m_task = nullptr;
+	}
+
+private:
+	void runTasks(const std::function<void(int)>& task, int count)
+	{
+		int index;
+		while ((index = m_nextIndex++) < count)
+		{
+			task(index);
+			m_finished++;
+		}
+	}
+
+	void workerLoop()
+	{
+		unsigned seenGeneration = 0;
+
+		for (;;)
+		{
+			const std::function<void(int)>* task;
+			int count;
+			{
+				std::unique_lock<std::mutex> lock(m_mutex);
+				m_wake.wait(lock, [this, seenGeneration] { return m_stop || (m_task && m_generation != seenGeneration); });
+				if (m_stop)
+					return;
+
+				seenGeneration = m_generation;
+				task = m_task;
+				count = m_taskCount;
+				m_busyWorkers++;
+			}
+
+			runTasks(*task, count);
+
+			{
+				std::lock_guard<std::mutex> lock(m_mutex);
+				m_busyWorkers--;
+			}
+			m_done.notify_one();
+		}
+	}
+};
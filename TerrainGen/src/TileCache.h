@@ -0,0 +1,259 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <list>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "vendor/noise/FastNoise.h"
+
+// Floats compare and hash by their bits, so a key always equals itself and hashes consistently
+inline uint32_t floatBits(float f)
+{
+	uint32_t u;
+	std::memcpy(&u, &f, sizeof(u));
+	return u;
+}
+
+// Every setting of a FastNoise that changes its values: the general and fractal settings,
+// the cellular settings and the GradientPerturb amplitude
+struct NoiseKey
+{
+	int seed = 0;
+	int noiseType = 0;
+	int fractalType = 0;
+	int interp = 0;
+	int hashType = 0;
+	int octaves = 0;
+	float frequency = 0.0f;
+	float lacunarity = 0.0f;
+	float gain = 0.0f;
+	float sampleSpacing = 0.0f;
+
+	int cellularDistance = 0;
+	int cellularReturn = 0;
+	int cellularIndex0 = 0;
+	int cellularIndex1 = 0;
+	float cellularJitter = 0.0f;
+
+	float gradientPerturbAmp = 0.0f;
+
+	NoiseKey() = default;
+
+	explicit NoiseKey(const FastNoise& noise)
+		:seed(noise.GetSeed()), noiseType(noise.GetNoiseType()), fractalType(noise.GetFractalType()),
+		interp(noise.GetInterp()), hashType(noise.GetHashType()), octaves(noise.GetFractalOctaves()),
+		frequency(noise.GetFrequency()), lacunarity(noise.GetFractalLacunarity()), gain(noise.GetFractalGain()),
+		sampleSpacing(noise.GetFractalSampleSpacing()), cellularDistance(noise.GetCellularDistanceFunction()),
+		cellularReturn(noise.GetCellularReturnType()), cellularJitter(noise.GetCellularJitter()),
+		gradientPerturbAmp(noise.GetGradientPerturbAmp())
+	{
+		noise.GetCellularDistance2Indices(cellularIndex0, cellularIndex1);
+	}
+
+	bool operator==(const NoiseKey& other) const
+	{
+		return seed == other.seed && noiseType == other.noiseType && fractalType == other.fractalType &&
+			interp == other.interp && hashType == other.hashType && octaves == other.octaves &&
+			floatBits(frequency) == floatBits(other.frequency) && floatBits(lacunarity) == floatBits(other.lacunarity) &&
+			floatBits(gain) == floatBits(other.gain) && floatBits(sampleSpacing) == floatBits(other.sampleSpacing) &&
+			cellularDistance == other.cellularDistance && cellularReturn == other.cellularReturn &&
+			cellularIndex0 == other.cellularIndex0 && cellularIndex1 == other.cellularIndex1 &&
+			floatBits(cellularJitter) == floatBits(other.cellularJitter) &&
+			floatBits(gradientPerturbAmp) == floatBits(other.gradientPerturbAmp);
+	}
+};
+
+// Everything that decides the contents of a generated tile: the noise settings, the sample grid
+// and what was generated from them (mode, chosen by the caller, e.g. heights only or heights and normals)
+struct TileKey
+{
+	NoiseKey noise;
+	// Settings of the cellular lookup noise when noise returns NoiseLookup, default otherwise
+	NoiseKey lookup;
+
+	float x0 = 0.0f;
+	float y0 = 0.0f;
+	float step = 0.0f;
+	int width = 0;
+	int height = 0;
+
+	int mode = 0;
+
+	TileKey() = default;
+
+	// Settings of noise, sampled at x0 + col * step, y0 + row * step for width x height samples
+	// A NoiseLookup's own lookup isn't part of the key, the lookup noise can't return NoiseLookup itself
+	TileKey(const FastNoise& noise, float x0, float y0, float step, int width, int height, int mode)
+		:noise(noise), x0(x0), y0(y0), step(step), width(width), height(height), mode(mode)
+	{
+		const FastNoise* lookupNoise = noise.GetCellularNoiseLookup();
+		if (usesLookup(noise) && lookupNoise)
+		{
+			assert(!usesLookup(*lookupNoise));
+			lookup = NoiseKey(*lookupNoise);
+		}
+	}
+
+	bool operator==(const TileKey& other) const
+	{
+		return noise == other.noise && lookup == other.lookup &&
+			floatBits(x0) == floatBits(other.x0) && floatBits(y0) == floatBits(other.y0) && floatBits(step) == floatBits(other.step) &&
+			width == other.width && height == other.height && mode == other.mode;
+	}
+
+	static bool usesLookup(const FastNoise& noise)
+	{
+		return noise.GetNoiseType() == FastNoise::Cellular && noise.GetCellularReturnType() == FastNoise::NoiseLookup;
+	}
+};
+
+struct TileKeyHash
+{
+	// FNV-1a over the fields
+	size_t operator()(const TileKey& key) const
+	{
+		uint64_t hash = 14695981039346656037ull;
+		add(hash, key.noise);
+		add(hash, key.lookup);
+
+		const uint32_t fields[] = {
+			floatBits(key.x0), floatBits(key.y0), floatBits(key.step),
+			static_cast<uint32_t>(key.width), static_cast<uint32_t>(key.height), static_cast<uint32_t>(key.mode) };
+		for (uint32_t field : fields)
+			add(hash, field);
+		return static_cast<size_t>(hash);
+	}
+
+	static void add(uint64_t& hash, const NoiseKey& noise)
+	{
+		const uint32_t fields[] = {
+			static_cast<uint32_t>(noise.seed), static_cast<uint32_t>(noise.noiseType), static_cast<uint32_t>(noise.fractalType),
+			static_cast<uint32_t>(noise.interp), static_cast<uint32_t>(noise.hashType), static_cast<uint32_t>(noise.octaves),
+			floatBits(noise.frequency), floatBits(noise.lacunarity), floatBits(noise.gain), floatBits(noise.sampleSpacing),
+			static_cast<uint32_t>(noise.cellularDistance), static_cast<uint32_t>(noise.cellularReturn),
+			static_cast<uint32_t>(noise.cellularIndex0), static_cast<uint32_t>(noise.cellularIndex1),
+			floatBits(noise.cellularJitter), floatBits(noise.gradientPerturbAmp) };
+		for (uint32_t field : fields)
+			add(hash, field);
+	}
+
+	static void add(uint64_t& hash, uint32_t field)
+	{
+		for (int byte = 0; byte < 4; byte++)
+		{
+			hash ^= (field >> (byte * 8)) & 0xff;
+			hash *= 1099511628211ull;
+		}
+	}
+};
+
+// Generated tiles kept in memory, so going back to a seed or settings seen before is a copy
+// instead of a regeneration. A tile is any float data, the caller decides the layout.
+// Bounded by the bytes of the stored data, the least recently used tiles are evicted first.
+// Not thread safe, meant for the thread that decides what to generate.
+class TileCache
+{
+	struct Entry
+	{
+		TileKey key;
+		std::vector<float> data;
+	};
+
+	// Most recently used first
+	std::list<Entry> m_entries;
+	std::unordered_map<TileKey, std::list<Entry>::iterator, TileKeyHash> m_index;
+
+	size_t m_maxBytes;
+	size_t m_bytes = 0;
+
+	size_t m_hits = 0;
+	size_t m_misses = 0;
+	size_t m_evictions = 0;
+
+	static size_t entryBytes(const std::vector<float>& data)
+	{
+		return data.size() * sizeof(float);
+	}
+
+	void evictTo(size_t maxBytes)
+	{
+		while (m_bytes > maxBytes && !m_entries.empty())
+		{
+			Entry& last = m_entries.back();
+			m_bytes -= entryBytes(last.data);
+			m_index.erase(last.key);
+			m_entries.pop_back();
+			m_evictions++;
+		}
+	}
+
+public:
+	// maxBytes = 0 disables the cache, every lookup misses
+	explicit TileCache(size_t maxBytes)
+		:m_maxBytes(maxBytes)
+	{}
+
+	// Cached data of key, nullptr on a miss
+	// A hit makes the tile the most recently used one, the pointer stays valid until the next insert or clear
+	const std::vector<float>* find(const TileKey& key)
+	{
+		auto found = m_index.find(key);
+		if (found == m_index.end())
+		{
+			m_misses++;
+			return nullptr;
+		}
+
+		m_entries.splice(m_entries.begin(), m_entries, found->second);
+		m_hits++;
+		return &found->second->data;
+	}
+
+	// Stores data as the most recently used tile, replacing an older tile with the same key
+	// Evicts until the cache fits its budget, a tile larger than the whole budget isn't stored
+	void insert(const TileKey& key, std::vector<float> data)
+	{
+		auto found = m_index.find(key);
+		if (found != m_index.end())
+		{
+			m_bytes -= entryBytes(found->second->data);
+			m_entries.erase(found->second);
+			m_index.erase(found);
+		}
+
+		size_t bytes = entryBytes(data);
+		if (bytes > m_maxBytes)
+			return;
+
+		evictTo(m_maxBytes - bytes);
+		m_entries.push_front(Entry{ key, std::move(data) });
+		m_index.emplace(key, m_entries.begin());
+		m_bytes += bytes;
+	}
+
+	void clear()
+	{
+		m_entries.clear();
+		m_index.clear();
+		m_bytes = 0;
+	}
+
+	void setMaxBytes(size_t maxBytes)
+	{
+		m_maxBytes = maxBytes;
+		evictTo(m_maxBytes);
+	}
+
+	size_t getMaxBytes() const { return m_maxBytes; }
+	size_t getBytes() const { return m_bytes; }
+	size_t getTileCount() const { return m_entries.size(); }
+
+	size_t getHits() const { return m_hits; }
+	size_t getMisses() const { return m_misses; }
+	size_t getEvictions() const { return m_evictions; }
+};
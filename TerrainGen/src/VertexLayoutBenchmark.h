@@ -0,0 +1,64 @@
+#pragma once
+
+#include <glad/glad.h>
+#include <chrono>
+#include <iostream>
+
+#include "TerrainVertices.h"
+
+// Times the Separate and Interleaved layouts of TerrainVertices on the current context, with the
+// attributes of mesh and the index buffer ebo holding indexCount indices
+// upload: upload() up to glFinish, timed on the CPU, so the driver's copy of the data is included
+// vertex fetch: drawing the mesh with the shader in use into a 1x1 viewport, timed with GL_TIME_ELAPSED,
+// the tiny viewport leaves vertex fetch and the vertex shader as the cost of the draw
+// Prints the vertex data size and the average per upload and per draw, leaves the depth and colour buffers to be cleared
+inline void benchmarkVertexLayouts(TerrainVertices& mesh, unsigned int ebo, int indexCount, int repeats)
+{
+	GLint viewport[4];
+	glGetIntegerv(GL_VIEWPORT, viewport);
+	glViewport(0, 0, 1, 1);
+
+	unsigned int query;
+	glGenQueries(1, &query);
+
+	const TerrainVertices::Layout layouts[] = { TerrainVertices::Separate, TerrainVertices::Interleaved };
+	for (TerrainVertices::Layout layout : layouts)
+	{
+		TerrainVertices vertices(mesh.getCount(), layout);
+		vertices.copyFrom(mesh);
+
+		unsigned int vao;
+		glGenVertexArrays(1, &vao);
+		glBindVertexArray(vao);
+		vertices.createBuffers();
+		glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, ebo);
+
+		vertices.upload();
+		glFinish();
+
+		auto start = std::chrono::steady_clock::now();
+		for (int i = 0; i < repeats; i++)
+			vertices.upload();
+		glFinish();
+		double uploadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() / repeats;
+
+		glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+		glBeginQuery(GL_TIME_ELAPSED, query);
+		for (int i = 0; i < repeats; i++)
+			glDrawElements(GL_TRIANGLES, indexCount, GL_UNSIGNED_INT, 0);
+		glEndQuery(GL_TIME_ELAPSED);
+
+		GLuint64 drawNs = 0;
+		glGetQueryObjectui64v(query, GL_QUERY_RESULT, &drawNs);
+
+		std::cout << (layout == TerrainVertices::Interleaved ? "interleaved" : "separate") << " vertices: "
+			<< vertices.getBytesPerVertex() * vertices.getCount() / 1024 << " KiB, upload " << uploadMs << " ms, draw " << drawNs / 1e6 / repeats << " ms" << std::endl;
+
+		glBindVertexArray(0);
+		glDeleteVertexArrays(1, &vao);
+		vertices.deleteBuffers();
+	}
+
+	glDeleteQueries(1, &query);
+	glViewport(viewport[0], viewport[1], viewport[2], viewport[3]);
+}
@@ -63,6 +63,27 @@ project "TerrainGen"
 		"Shell32.lib"
 	}
 
+	-- FastNoise batch kernels, one translation unit per instruction set
+	-- The CPU is checked at runtime before any of them is called
+	filter "files:**/noise/FastNoiseSIMD_sse2.cpp"
+		vectorextensions "SSE2"
+
+	filter "files:**/noise/FastNoiseSIMD_sse41.cpp"
+		vectorextensions "SSE4.1"
+
+	filter "files:**/noise/FastNoiseSIMD_avx2.cpp"
+		vectorextensions "AVX2"
+
+	filter { "files:**/noise/FastNoiseSIMD_avx512.cpp", "toolset:msc*" }
+		buildoptions "/arch:AVX512"
+
+	filter { "files:**/noise/FastNoiseSIMD_avx512.cpp", "toolset:not msc*" }
+		buildoptions "-mavx512f"
+
+	-- -mavx512f implies FMA, keep the kernels bit-identical to the scalar path
+	filter { "files:**/noise/FastNoiseSIMD_*.cpp", "toolset:not msc*" }
+		buildoptions "-ffp-contract=off"
+
 	filter "configurations:Debug"
 		runtime "Debug"
 		symbols "on"